@@ -1,42 +1,203 @@
 ﻿#pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <filesystem>
-#include <unordered_map>
+#include <map>
+#include <string_view>
 #include <cassert>
 #include <regex>
 #include "DatVFS/DatVFSCommon.h"
 
 class DatVFS {
-    using FolderMap = std::unordered_map<std::string,DatVFS*>;
-    using FileMap = std::unordered_map<std::string,IDVFSFile*>;
+    // Ordered maps so directory listings come out sorted and prefix/range lookups are O(log n)
+    using FolderMap = std::map<std::string,DatVFS*,std::less<>>;
+    using FileMap = std::map<std::string,IDVFSFile*,std::less<>>;
 
     FolderMap folders;
     FileMap files;
 
+    // The real parent of this directory (nullptr for the root, unlike "..")
+    DatVFS* parent = nullptr;
+    // The amount of files inside and below this directory, kept up to date as files are inserted and removed
+    size_t fileCount = 0;
+
+    /**
+     * Creates a subdirectory, only used by createSingleFolder so the parent always owns the child
+     * @param parent The directory this directory is inside of
+     */
+    explicit DatVFS(DatVFS* parent) : parent(parent) {
+        folders["."] = this;
+        folders[".."] = parent;
+    }
+
+    /**
+     * Adds to the file count of this directory and all the directories above it
+     * @param delta The amount to change the file count by
+     */
+    void adjustFileCount(std::ptrdiff_t delta) {
+        for (DatVFS* folder = this; folder; folder = folder->parent) {
+            folder->fileCount += delta;
+        }
+    }
+
+    /**
+     * Drops a reference to the given IDVFSFile, deleting it if nothing else in the VFS refers to it
+     * @param dvfsFile The file to release
+     */
+    static void releaseFile(IDVFSFile* dvfsFile) {
+        if (dvfsFile && --(*dvfsFile) == 0) {
+            delete dvfsFile;
+        }
+    }
+
+    /**
+     * Checks if the given folder name is one of the special entries "." or ".."
+     * @param folderName The name to check
+     * @return If the name is a special entry
+     */
+    static bool isSpecialFolder(std::string_view folderName) {
+        return folderName == "." || folderName == "..";
+    }
+
+    /**
+     * Gets the first entry in the map that sorts after every key starting with the given prefix
+     * @param map The map to search
+     * @param prefix The prefix the keys start with
+     * @return An iterator to the first entry past the keys starting with the prefix
+     */
+    template<typename Map>
+    static typename Map::const_iterator prefixEnd(const Map& map, std::string_view prefix) {
+        std::string upper(prefix);
+
+        // Drop any trailing chars that can't be incremented, the prefix before them bounds the range instead
+        while (!upper.empty() && static_cast<unsigned char>(upper.back()) == 0xFF) {
+            upper.pop_back();
+        }
+        if (upper.empty()) return map.end();
+
+        upper.back() = static_cast<char>(static_cast<unsigned char>(upper.back()) + 1);
+        return map.lower_bound(upper);
+    }
+
 public:
+    /**
+     * A sorted view over a range of entries in a directory
+     * Does not copy the directory, so it is invalidated when the entries it covers are removed
+     * @tparam Map The map the entries belong to
+     * @tparam SkipSpecial If the special folder entries "." and ".." should be skipped
+     */
+    template<typename Map, bool SkipSpecial>
+    class DirectoryRange {
+        using MapIterator = typename Map::const_iterator;
+
+        MapIterator first;
+        MapIterator last;
+
+    public:
+        class iterator {
+            MapIterator it;
+            MapIterator last;
+
+            void skipSpecial() {
+                if constexpr (SkipSpecial) {
+                    while (it != last && isSpecialFolder(it->first)) ++it;
+                }
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = typename Map::value_type;
+            using difference_type = typename Map::difference_type;
+            using pointer = const value_type*;
+            using reference = const value_type&;
+
+            iterator() = default;
+            iterator(MapIterator it, MapIterator last) : it(it), last(last) {
+                skipSpecial();
+            }
+
+            reference operator*() const {
+                return *it;
+            }
+
+            pointer operator->() const {
+                return &*it;
+            }
+
+            iterator& operator++() {
+                ++it;
+                skipSpecial();
+                return *this;
+            }
+
+            iterator operator++(int) {
+                iterator old = *this;
+                ++*this;
+                return old;
+            }
+
+            bool operator==(const iterator& other) const {
+                return it == other.it;
+            }
+
+            bool operator!=(const iterator& other) const {
+                return it != other.it;
+            }
+        };
+
+        DirectoryRange(MapIterator first, MapIterator last) : first(first), last(last) {}
+
+        [[nodiscard]] iterator begin() const {
+            return iterator(first, last);
+        }
+
+        [[nodiscard]] iterator end() const {
+            return iterator(last, last);
+        }
+
+        [[nodiscard]] bool empty() const {
+            return begin() == end();
+        }
+    };
+
+    using FolderRange = DirectoryRange<FolderMap, true>;
+    using FileRange = DirectoryRange<FileMap, false>;
+
+
     DatVFS() {
         folders["."] = this;
         // Since we don't know who the parent is, we'll just have to point .. at itself aswell
         folders[".."] = this;
     }
 
-    explicit DatVFS(DatVFS* parent) {
-        folders["."] = this;
-        folders[".."] = parent;
+    // The VFS owns its folders and files, so it cannot be copied
+    DatVFS(const DatVFS&) = delete;
+    DatVFS& operator=(const DatVFS&) = delete;
+
+    /**
+     * Deletes all the folders below this directory and releases the files in them
+     */
+    ~DatVFS() {
+        for (auto& folder: folders) {
+            if (!isSpecialFolder(folder.first)) {
+                assert(folder.second);
+                delete folder.second;
+            }
+        }
+
+        for (auto& file: files) {
+            releaseFile(file.second);
+        }
     }
 
     /**
      * Counts all the files inside and below this directory in the VFS
      * @return The amount of files inside and below this directory in the VFS
      */
-    size_t countFiles() {
-        size_t count = files.size();
-        for (auto& folder: folders) {
-            count += folder.second->countFiles();
-        }
-        return count;
+    [[nodiscard]] size_t countFiles() const {
+        return fileCount;
     }
 
     /**
@@ -64,7 +225,7 @@ public:
         }
 
         // add count of each subdirectory
-        for (auto& folder: folders) {
+        for (auto& folder: listFolders()) {
             count += folder.second->countFilesMatchingRegex(regex);
         }
 
@@ -79,7 +240,8 @@ public:
      */
     IDVFSFile* getFile(const std::vector<std::string>& filePath, size_t index = 0) {
         if (index == filePath.size() - 1) {
-            return files[filePath[index]];
+            FileMap::iterator fileIt = files.find(filePath[index]);
+            return fileIt == files.end() ? nullptr : fileIt->second;
         } else if (index < filePath.size()) {
             FolderMap::iterator folderIt = folders.find(filePath[index]);
             DatVFS* folder;
@@ -113,7 +275,8 @@ public:
      */
     DatVFS* getFolder(const std::vector<std::string>& folderPath, size_t index = 0) {
         if (index == folderPath.size() - 1) {
-            return folders[folderPath[index]];
+            FolderMap::iterator folderIt = folders.find(folderPath[index]);
+            return folderIt == folders.end() ? nullptr : folderIt->second;
         } else if (index < folderPath.size()) {
             FolderMap::iterator folderIt = folders.find(folderPath[index]);
             DatVFS* folder;
@@ -123,7 +286,7 @@ public:
                 folder = folderIt->second;
             }
 
-            return folders[folderPath[index]]->getFolder(folderPath, index + 1);
+            return folder->getFolder(folderPath, index + 1);
         } else {
             return nullptr;
         }
@@ -141,6 +304,80 @@ public:
         return getFolder(folderPathList, 0);
     }
 
+    /**
+     * Gets all the files in this directory, sorted by name
+     * @return A sorted range over the files in this directory
+     */
+    [[nodiscard]] FileRange listFiles() const {
+        return {files.begin(), files.end()};
+    }
+
+    /**
+     * Gets the files in this directory whose names start with the given prefix, sorted by name
+     * @param prefix The prefix the file names must start with
+     * @return A sorted range over the matching files
+     */
+    [[nodiscard]] FileRange listFilesWithPrefix(std::string_view prefix) const {
+        return {files.lower_bound(prefix), prefixEnd(files, prefix)};
+    }
+
+    /**
+     * Gets the files in this directory whose names fall between first (inclusive) and last (exclusive), sorted by name
+     * @param first The name to start from
+     * @param last The name to stop before
+     * @return A sorted range over the matching files
+     */
+    [[nodiscard]] FileRange listFilesInRange(std::string_view first, std::string_view last) const {
+        if (last <= first) return {files.end(), files.end()};
+        return {files.lower_bound(first), files.lower_bound(last)};
+    }
+
+    /**
+     * Gets the files in this directory that sort after the given name, for paging through large directories
+     * @param name The name to continue after (usually the last name from the previous page)
+     * @return A sorted range over the files after the given name
+     */
+    [[nodiscard]] FileRange listFilesAfter(std::string_view name) const {
+        return {files.upper_bound(name), files.end()};
+    }
+
+    /**
+     * Gets all the folders in this directory, sorted by name (excluding "." and "..")
+     * @return A sorted range over the folders in this directory
+     */
+    [[nodiscard]] FolderRange listFolders() const {
+        return {folders.begin(), folders.end()};
+    }
+
+    /**
+     * Gets the folders in this directory whose names start with the given prefix, sorted by name
+     * @param prefix The prefix the folder names must start with
+     * @return A sorted range over the matching folders
+     */
+    [[nodiscard]] FolderRange listFoldersWithPrefix(std::string_view prefix) const {
+        return {folders.lower_bound(prefix), prefixEnd(folders, prefix)};
+    }
+
+    /**
+     * Gets the folders in this directory whose names fall between first (inclusive) and last (exclusive), sorted by name
+     * @param first The name to start from
+     * @param last The name to stop before
+     * @return A sorted range over the matching folders
+     */
+    [[nodiscard]] FolderRange listFoldersInRange(std::string_view first, std::string_view last) const {
+        if (last <= first) return {folders.end(), folders.end()};
+        return {folders.lower_bound(first), folders.lower_bound(last)};
+    }
+
+    /**
+     * Gets the folders in this directory that sort after the given name, for paging through large directories
+     * @param name The name to continue after (usually the last name from the previous page)
+     * @return A sorted range over the folders after the given name
+     */
+    [[nodiscard]] FolderRange listFoldersAfter(std::string_view name) const {
+        return {folders.upper_bound(name), folders.end()};
+    }
+
     /**
      * Creates a folder within the current directory
      * @param folderName The name of the folder (cannot contain backslashes or forward slashes)
@@ -202,16 +439,24 @@ public:
      * Inserts the IDVFSFile into VFS
      * If there is already a file there, then it will be overwritten
      * @param filePath The path to the file
-     * @param dvfsFile The file to insert
+     * @param dvfsFile The file to insert (cannot be null)
      * @param pathIndex (Optional) The index of the path to start from
      * @return If the file was successfully inserted
      */
     bool insertFile(const std::vector<std::string>& filePath, IDVFSFile* dvfsFile, bool createFolders = true, size_t pathIndex = 0) {
+        if (!dvfsFile) return false;
+
         if (pathIndex == filePath.size() - 1) {
-            if (files.count(filePath[pathIndex]) > 0) {
-                delete files[filePath[pathIndex]];
+            ++(*dvfsFile);
+
+            FileMap::iterator fileIt = files.find(filePath[pathIndex]);
+            if (fileIt != files.end()) {
+                releaseFile(fileIt->second);
+                fileIt->second = dvfsFile;
+            } else {
+                files.emplace(filePath[pathIndex], dvfsFile);
+                adjustFileCount(1);
             }
-            files[filePath[pathIndex]] = dvfsFile;
             return true;
         } else if (pathIndex < filePath.size()) {
             FolderMap::iterator folderIt = folders.find(filePath[pathIndex]);
@@ -234,7 +479,7 @@ public:
     /**
      * Inserts the IDVFSFile into VFS
      * @param filePath The path to the file
-     * @param dvfsFile The file to insert
+     * @param dvfsFile The file to insert (cannot be null)
      * @return If the file was successfully inserted
      */
     bool insertFile(const std::string& filePath, IDVFSFile* dvfsFile, bool createFolders = true) {
@@ -251,15 +496,16 @@ public:
      */
     bool insertFiles(const IDVFSInserter& inserter, size_t mountIndex = 0) {
         if (!inserter.mountPoint.empty() && mountIndex < inserter.mountPoint.size() - 1) {
-            DatVFS* folder = folders[inserter.mountPoint[mountIndex]];
+            FolderMap::iterator folderIt = folders.find(inserter.mountPoint[mountIndex]);
+            if (folderIt == folders.end()) return false;
 
-            if (folder) return folder->insertFiles(inserter, mountIndex + 1);
-            else return false;
+            return folderIt->second->insertFiles(inserter, mountIndex + 1);
         }
 
         for (const auto& item : inserter.getAllFiles()) {
             insertFile(item.first, item.second, true);
         }
+        return true;
     }
 
 //    /**
@@ -276,16 +522,98 @@ public:
 //        return Files;
 //    }
 
+    /**
+     * Removes the file at the given path, deleting the IDVFSFile if nothing else in the VFS refers to it
+     * @param filePath The path to the file
+     * @param index (Optional) The index of the path to start from
+     * @return If the file was found and removed
+     */
+    bool removeFile(const std::vector<std::string>& filePath, size_t index = 0) {
+        if (index == filePath.size() - 1) {
+            FileMap::iterator fileIt = files.find(filePath[index]);
+            if (fileIt == files.end()) return false;
+
+            releaseFile(fileIt->second);
+            files.erase(fileIt);
+            adjustFileCount(-1);
+            return true;
+        } else if (index < filePath.size()) {
+            FolderMap::iterator folderIt = folders.find(filePath[index]);
+            if (folderIt == folders.end()) return false;
+
+            return folderIt->second->removeFile(filePath, index + 1);
+        } else {
+            return false;
+        }
+    }
+
+    /**
+     * Removes the file at the given path, deleting the IDVFSFile if nothing else in the VFS refers to it
+     * @param filePath The path to the file
+     * @return If the file was found and removed
+     */
+    bool removeFile(const std::string& filePath) {
+        std::vector<std::string> filePathList = stringPathToVectorPath(filePath);
+
+        return removeFile(filePathList, 0);
+    }
+
+    /**
+     * Removes the folder at the given path along with everything below it
+     * @param folderPath The path of the folder
+     * @param index (Optional) The index of the path to start from
+     * @return If the folder was found and removed
+     */
+    bool removeFolder(const std::vector<std::string>& folderPath, size_t index = 0) {
+        if (index == folderPath.size() - 1) {
+            if (isSpecialFolder(folderPath[index])) return false;
+
+            FolderMap::iterator folderIt = folders.find(folderPath[index]);
+            if (folderIt == folders.end()) return false;
+
+            DatVFS* folder = folderIt->second;
+            folders.erase(folderIt);
+            adjustFileCount(-static_cast<std::ptrdiff_t>(folder->fileCount));
+            delete folder;
+            return true;
+        } else if (index < folderPath.size()) {
+            FolderMap::iterator folderIt = folders.find(folderPath[index]);
+            if (folderIt == folders.end()) return false;
+
+            return folderIt->second->removeFolder(folderPath, index + 1);
+        } else {
+            return false;
+        }
+    }
+
+    /**
+     * Removes the folder at the given path along with everything below it
+     * @param folderPath The path of the folder
+     * @return If the folder was found and removed
+     */
+    bool removeFolder(const std::string& folderPath) {
+        std::vector<std::string> folderPathList = stringPathToVectorPath(folderPath);
+
+        return removeFolder(folderPathList, 0);
+    }
+
     /**
      * Removes all empty directories below this directory in the VFS
      */
     void prune() {
         for (auto it = folders.begin(); it != folders.end();) {
-            it->second->prune();
-            if (it->second->countFiles() == 0) {
+            if (isSpecialFolder(it->first)) {
+                ++it;
+                continue;
+            }
+
+            assert(it->second);
+            if (it->second->fileCount == 0) {
+                // Nothing below it has files, so the whole subtree goes without needing to prune it first
                 delete it->second;
-                folders.erase(it++);
+                it = folders.erase(it);
             } else {
+                it->second->prune();
                 ++it;
             }
         }
@@ -302,11 +630,9 @@ public:
         std::cout << Prefix << (Depth != 0 ? "-" : "") << ".." << "/" << std::endl;
 
         // Print folders and their subdirectories & files
-        for (auto& folder: folders) {
-            if (!(folder.first == "." || folder.first == "..")) {
-                std::cout << Prefix << (Depth != 0 ? "-" : "") << folder.first << "/" << std::endl;
-                folder.second->tree(Prefix + " |", Depth + 1);
-            }
+        for (auto& folder: listFolders()) {
+            std::cout << Prefix << (Depth != 0 ? "-" : "") << folder.first << "/" << std::endl;
+            folder.second->tree(Prefix + " |", Depth + 1);
         }
 
         // Print Files
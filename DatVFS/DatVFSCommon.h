@@ -38,7 +38,7 @@ inline std::vector<std::string> stringPathToVectorPath(const std::string& path)
  * Also contains logic for handling multiple entries in the VFS of the same IDVFSFile
  */
 class IDVFSFile {
-    uint8_t references = 0;
+    size_t references = 0;
 protected:
     size_t fileSize = 0;
 public:
@@ -62,7 +62,7 @@ public:
      * Gets a count of the references to this DVFSFile in the VFS
      * @return The number of references to this DVFSFile in the VFS
      */
-    [[maybe_unused]] [[nodiscard]] uint8_t getReferenceCount() const {
+    [[maybe_unused]] [[nodiscard]] size_t getReferenceCount() const {
         return references;
     }
 
@@ -70,7 +70,7 @@ public:
      * Increments the number of references
      * @return the new number of references
      */
-    uint8_t& operator++() {
+    size_t& operator++() {
         return ++references;
     }
 
@@ -78,7 +78,7 @@ public:
      * Decrements the number of references
      * @return the new number of references
      */
-    uint8_t& operator--() {
+    size_t& operator--() {
         return --references;
     }
 
@@ -0,0 +1,95 @@
+#include <cstdlib>
+#include "DatVFS.h"
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": Check failed: " #condition << std::endl; \
+            return EXIT_FAILURE; \
+        } \
+    } while (0)
+
+/**
+ * A DVFS File with no content
+ */
+struct EmptyFile : IDVFSFile {
+    [[nodiscard]] bool isValidFile() const override {
+        return true;
+    }
+
+    bool getContent(char*) const override {
+        return true;
+    }
+};
+
+/**
+ * Collects the names in a directory range, in the order the range gives them
+ * @param range The range to collect the names from
+ * @return The names in the range
+ */
+template<typename Range>
+std::vector<std::string> names(const Range& range) {
+    std::vector<std::string> result;
+    for (const auto& entry: range) {
+        result.push_back(entry.first);
+    }
+    return result;
+}
+
+using Names = std::vector<std::string>;
+
+int main() {
+    DatVFS vfs;
+    for (const char* name: {"btn_ok", "btn_cancel", "bg", "btn", "bto", "btz", "btn\xff", "btn\xff\x01", ".", ".."}) {
+        CHECK(vfs.insertFile(std::string("textures/ui/") + name, new EmptyFile()));
+    }
+
+    DatVFS* ui = vfs.getFolder("textures/ui/");
+    CHECK(ui);
+    CHECK(ui->createSingleFolder("-sub"));
+    CHECK(ui->createSingleFolder("icons"));
+    CHECK(ui->createSingleFolder("items"));
+
+    // Files are sorted and files named . and .. are still listed
+    Names allFiles = {".", "..", "bg", "btn", "btn_cancel", "btn_ok", "btn\xff", "btn\xff\x01", "bto", "btz"};
+    CHECK(names(ui->listFiles()) == allFiles);
+    CHECK(ui->countFiles() == allFiles.size());
+
+    // Folders are sorted and skip . and .., even when a name sorts before them
+    CHECK((names(ui->listFolders()) == Names{"-sub", "icons", "items"}));
+    CHECK(ui->listFoldersWithPrefix(".").empty());
+
+    // Prefix queries
+    CHECK((names(ui->listFilesWithPrefix("btn_")) == Names{"btn_cancel", "btn_ok"}));
+    CHECK((names(ui->listFilesWithPrefix("btn")) == Names{"btn", "btn_cancel", "btn_ok", "btn\xff", "btn\xff\x01"}));
+    CHECK((names(ui->listFilesWithPrefix("btn\xff")) == Names{"btn\xff", "btn\xff\x01"}));
+    CHECK((names(ui->listFilesWithPrefix("\xff")).empty()));
+    CHECK(names(ui->listFilesWithPrefix("")) == allFiles);
+    CHECK((names(ui->listFoldersWithPrefix("i")) == Names{"icons", "items"}));
+
+    // Range queries, where last is exclusive
+    CHECK((names(ui->listFilesInRange("b", "btn_")) == Names{"bg", "btn"}));
+    CHECK(ui->listFilesInRange("btn", "btn").empty());
+    CHECK(ui->listFilesInRange("bto", "bg").empty());
+    CHECK((names(ui->listFoldersInRange("a", "j")) == Names{"icons", "items"}));
+    CHECK(ui->listFoldersInRange("j", "a").empty());
+
+    // Paging through the directory two entries at a time
+    Names paged;
+    std::string last;
+    for (bool first = true;; first = false) {
+        DatVFS::FileRange page = first ? ui->listFiles() : ui->listFilesAfter(last);
+        size_t count = 0;
+        for (auto it = page.begin(); it != page.end() && count < 2; ++it, ++count) {
+            paged.push_back(it->first);
+            last = it->first;
+        }
+        if (count == 0) break;
+    }
+    CHECK(paged == allFiles);
+    CHECK((names(ui->listFoldersAfter("-sub")) == Names{"icons", "items"}));
+    CHECK(ui->listFoldersAfter("items").empty());
+    CHECK(ui->listFilesAfter("btz").empty());
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,129 @@
+#include <cstdlib>
+#include "DatVFS.h"
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": Check failed: " #condition << std::endl; \
+            return EXIT_FAILURE; \
+        } \
+    } while (0)
+
+/**
+ * A DVFS File that records how many times it has been deleted
+ */
+struct CountedFile : IDVFSFile {
+    int& deletions;
+
+    explicit CountedFile(int& deletions) : deletions(deletions) {}
+
+    ~CountedFile() override {
+        ++deletions;
+    }
+
+    [[nodiscard]] bool isValidFile() const override {
+        return true;
+    }
+
+    bool getContent(char*) const override {
+        return true;
+    }
+};
+
+/**
+ * Checks a file inserted at many paths is only deleted once the last of them is gone
+ */
+int testSharedFile() {
+    // Enough paths to overflow a narrow reference count
+    const int pathCount = 300;
+    int deletions = 0;
+    int otherDeletions = 0;
+
+    {
+        DatVFS vfs;
+        CountedFile* file = new CountedFile(deletions);
+
+        for (int i = 0; i < pathCount; ++i) {
+            CHECK(vfs.insertFile("folder" + std::to_string(i % 3) + "/file" + std::to_string(i), file));
+        }
+        CHECK(file->getReferenceCount() == pathCount);
+        CHECK(vfs.countFiles() == pathCount);
+
+        // Remove some of the entries
+        CHECK(vfs.removeFile("folder0/file0"));
+        CHECK(vfs.removeFile("folder1/file1"));
+        CHECK(!vfs.removeFile("folder1/file1"));
+        CHECK(file->getReferenceCount() == pathCount - 2);
+
+        // Overwrite some of the entries with a different file
+        CountedFile* other = new CountedFile(otherDeletions);
+        CHECK(vfs.insertFile("folder2/file2", other));
+        CHECK(vfs.insertFile("folder0/file3", other));
+        CHECK(file->getReferenceCount() == pathCount - 4);
+        CHECK(other->getReferenceCount() == 2);
+
+        // Reinserting a file over itself keeps it alive
+        CHECK(vfs.insertFile("folder0/file3", other));
+        CHECK(other->getReferenceCount() == 2);
+
+        // Removing a folder releases every entry below it
+        size_t folderFiles = vfs.getFolder("folder1")->countFiles();
+        CHECK(vfs.removeFolder("folder1"));
+        CHECK(vfs.countFiles() == pathCount - 2 - folderFiles);
+        CHECK(file->getReferenceCount() == pathCount - 4 - folderFiles);
+
+        // Null files are rejected rather than stored
+        CHECK(!vfs.insertFile("folder0/null", nullptr));
+        CHECK(!vfs.getFile("folder0/null"));
+
+        CHECK(deletions == 0);
+        CHECK(otherDeletions == 0);
+    }
+
+    CHECK(deletions == 1);
+    CHECK(otherDeletions == 1);
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Checks removing files keeps the counts up to date and prune only removes empty subtrees
+ */
+int testPrune() {
+    int deletions = 0;
+
+    DatVFS vfs;
+    CHECK(vfs.insertFile("p/q/r/f", new CountedFile(deletions)));
+    CHECK(vfs.insertFile("s/t/g", new CountedFile(deletions)));
+    CHECK(vfs.getFolder("s")->createSingleFolder("empty"));
+    CHECK(vfs.getFolder("s/empty")->createSingleFolder("deeper"));
+
+    CHECK(vfs.countFiles() == 2);
+    CHECK(vfs.getFolder("p")->countFiles() == 1);
+    CHECK(vfs.getFolder("p/q")->countFiles() == 1);
+
+    CHECK(vfs.removeFile("p/q/r/f"));
+    CHECK(deletions == 1);
+    CHECK(vfs.countFiles() == 1);
+    CHECK(vfs.getFolder("p")->countFiles() == 0);
+    CHECK(vfs.getFolder("p/q")->countFiles() == 0);
+    CHECK(vfs.getFolder("s")->countFiles() == 1);
+
+    vfs.prune();
+    CHECK(!vfs.getFolder("p"));
+    CHECK(vfs.getFolder("s"));
+    CHECK(vfs.getFolder("s/t"));
+    CHECK(!vfs.getFolder("s/empty"));
+    CHECK(vfs.getFile("s/t/g"));
+    CHECK(vfs.countFiles() == 1);
+    CHECK(deletions == 1);
+
+    return EXIT_SUCCESS;
+}
+
+int main() {
+    if (testSharedFile() != EXIT_SUCCESS) return EXIT_FAILURE;
+    if (testPrune() != EXIT_SUCCESS) return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}